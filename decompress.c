@@ -0,0 +1,482 @@
+/*
+ *     decompress.c
+ *     by agent, 10/18/2026
+ *     filesofpix
+ *
+ *     Function implementations for the decompression portion of the
+ *     program. Sniffs the first bytes of the input for a gzip or zstd magic
+ *     number. Compressed input is inflated on its own thread into a fixed
+ *     ring of blocks, and the blocks are handed to readaline through a
+ *     stdio stream, so decompressing and parsing overlap without any
+ *     temporary file or external pipe.
+ */
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <pthread.h>
+#include <zlib.h>
+#include <zstd.h>
+#include "decompress.h"
+
+#define RING_BLOCKS 8
+#define BLOCK_SIZE (64 * 1024)
+#define MAGIC_SIZE 4
+
+typedef enum { PLAIN, GZIP, ZSTD } Format;
+
+typedef struct Block {
+        char data[BLOCK_SIZE];
+        size_t len;
+} Block;
+
+typedef struct Ring {
+        /* owned by the decompressing thread */
+        FILE *source;
+        Format format;
+        unsigned char magic[MAGIC_SIZE];  /* sniffed bytes not yet consumed */
+        size_t magic_len;
+        unsigned char in[BLOCK_SIZE];
+        bool source_done;
+        bool frame_open;       /* zstd has started a frame it has not ended */
+        bool member_done;      /* a gzip member ended, next one unchecked */
+        bool trailing_done;    /* the rest of the gzip input is padding */
+
+        /* shared, guarded by lock */
+        Block blocks[RING_BLOCKS];
+        size_t produced;       /* blocks filled so far */
+        size_t consumed;       /* blocks fully read so far */
+        bool finished;         /* no more blocks will be filled */
+        bool stopping;         /* reader closed the stream early */
+        pthread_mutex_t lock;
+        pthread_cond_t filled;
+        pthread_cond_t drained;
+
+        /* owned by the reading thread */
+        size_t read_pos;       /* offset into the oldest filled block */
+        pthread_t thread;
+} Ring;
+
+Format sniff(const unsigned char *magic, size_t len);
+size_t read_source(Ring *ring, unsigned char *buf, size_t size);
+void *fill_ring(void *closure);
+size_t fill_plain(Ring *ring, char *out);
+size_t fill_gzip(Ring *ring, z_stream *zs, char *out);
+size_t fill_zstd(Ring *ring, ZSTD_DStream *zds, ZSTD_inBuffer *in, char *out);
+ssize_t ring_read(void *cookie, char *buf, size_t size);
+int ring_close(void *cookie);
+
+/*************decompress_open**************
+ * Use:
+ *      Checks whether source holds gzip or zstd compressed data and, if so,
+ *      starts a thread decompressing it
+ * Return:
+ *      source itself if it is plain and seekable, otherwise a new stream
+ *      reading the decompressed (or passed through) bytes
+ * Parameters:
+ *      FILE *source:          pointer to the input file stream
+ * Expects:
+ *      source is positioned at the start of the input
+ * Notes:
+ *      Will CRE if the ring or its thread cannot be created
+ *      When a new stream is returned it must be closed before source is
+ *      closed; source is left open
+ */
+FILE *decompress_open(FILE *source)
+{
+        assert(source != NULL);
+
+        Ring *ring = malloc(sizeof(*ring));
+        assert(ring != NULL);
+
+        long start = ftell(source);
+        ring->magic_len = fread(ring->magic, 1, MAGIC_SIZE, source);
+        assert(!ferror(source));
+        ring->format = sniff(ring->magic, ring->magic_len);
+
+        /* plain files that can be rewound need no thread at all */
+        if (ring->format == PLAIN && start != -1 &&
+            fseek(source, start, SEEK_SET) == 0) {
+                free(ring);
+                return source;
+        }
+
+        ring->source = source;
+        ring->source_done = false;
+        ring->frame_open = false;
+        ring->member_done = false;
+        ring->trailing_done = false;
+        ring->produced = 0;
+        ring->consumed = 0;
+        ring->finished = false;
+        ring->stopping = false;
+        ring->read_pos = 0;
+        pthread_mutex_init(&ring->lock, NULL);
+        pthread_cond_init(&ring->filled, NULL);
+        pthread_cond_init(&ring->drained, NULL);
+
+        int started = pthread_create(&ring->thread, NULL, fill_ring, ring);
+        assert(started == 0);
+
+        cookie_io_functions_t io = { ring_read, NULL, NULL, ring_close };
+        FILE *stream = fopencookie(ring, "r", io);
+        assert(stream != NULL);
+        return stream;
+}
+
+/*************is_compressed**************
+ * Use:
+ *      Checks the first bytes of a seekable input for a gzip or zstd magic
+ *      number without consuming them
+ * Return:
+ *      true if the input is gzip or zstd compressed
+ * Parameters:
+ *      FILE *source:          pointer to a seekable input file stream
+ * Expects:
+ *      source is positioned at the start of the input
+ * Notes:
+ *      Will CRE if reading or repositioning source fails
+ */
+bool is_compressed(FILE *source)
+{
+        unsigned char magic[MAGIC_SIZE];
+
+        long start = ftell(source);
+        assert(start != -1);
+        size_t len = fread(magic, 1, MAGIC_SIZE, source);
+        assert(!ferror(source));
+
+        int seeked = fseek(source, start, SEEK_SET);
+        assert(seeked == 0);
+        return sniff(magic, len) != PLAIN;
+}
+
+/*************sniff**************
+ * Use:
+ *      Identifies the compression format from the first bytes of the input
+ * Return:
+ *      GZIP or ZSTD if the matching magic number is present, PLAIN otherwise
+ * Parameters:
+ *      const unsigned char *magic:  first bytes of the input
+ *      size_t len:                  number of bytes in magic
+ * Expects:
+ *      None
+ */
+Format sniff(const unsigned char *magic, size_t len)
+{
+        static const unsigned char gzip_magic[] = { 0x1f, 0x8b };
+        static const unsigned char zstd_magic[] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+        if (len >= sizeof(gzip_magic) &&
+            memcmp(magic, gzip_magic, sizeof(gzip_magic)) == 0) {
+                return GZIP;
+        }
+        if (len >= sizeof(zstd_magic) &&
+            memcmp(magic, zstd_magic, sizeof(zstd_magic)) == 0) {
+                return ZSTD;
+        }
+        return PLAIN;
+}
+
+/*************read_source**************
+ * Use:
+ *      Reads the next raw input bytes, starting with the sniffed magic bytes
+ * Return:
+ *      number of bytes placed in buf, 0 once the input is exhausted
+ * Parameters:
+ *      Ring *ring:            ring whose source is read
+ *      unsigned char *buf:    buffer to read into
+ *      size_t size:           capacity of buf
+ * Expects:
+ *      size is at least MAGIC_SIZE
+ * Notes:
+ *      Will CRE if reading the source fails
+ */
+size_t read_source(Ring *ring, unsigned char *buf, size_t size)
+{
+        size_t n = ring->magic_len;
+        memcpy(buf, ring->magic, n);
+        ring->magic_len = 0;
+
+        n += fread(buf + n, 1, size - n, ring->source);
+        assert(!ferror(ring->source));
+
+        if (n == 0) {
+                ring->source_done = true;
+        }
+        return n;
+}
+
+/*************fill_ring**************
+ * Use:
+ *      Body of the decompressing thread. Fills free blocks of the ring with
+ *      decompressed bytes until the input ends or the reader stops
+ * Return:
+ *      NULL
+ * Parameters:
+ *      void *closure:         pointer to the Ring to fill
+ * Expects:
+ *      ring was set up by decompress_open
+ * Notes:
+ *      Will CRE if the input is corrupt or truncated
+ */
+void *fill_ring(void *closure)
+{
+        Ring *ring = closure;
+
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        ZSTD_DStream *zds = NULL;
+        ZSTD_inBuffer in = { ring->in, 0, 0 };
+
+        if (ring->format == GZIP) {
+                int ret = inflateInit2(&zs, 15 + 32); /* expect gzip header */
+                assert(ret == Z_OK);
+        } else if (ring->format == ZSTD) {
+                zds = ZSTD_createDStream();
+                assert(zds != NULL);
+        }
+
+        size_t len = 1;
+        while (len != 0) {
+                /* wait for the reader to free up a block */
+                pthread_mutex_lock(&ring->lock);
+                while (ring->produced - ring->consumed == RING_BLOCKS &&
+                       !ring->stopping) {
+                        pthread_cond_wait(&ring->drained, &ring->lock);
+                }
+                bool stopping = ring->stopping;
+                pthread_mutex_unlock(&ring->lock);
+                if (stopping) {
+                        break;
+                }
+
+                /* the free block belongs to this thread until published */
+                Block *block = &ring->blocks[ring->produced % RING_BLOCKS];
+                if (ring->format == GZIP) {
+                        len = fill_gzip(ring, &zs, block->data);
+                } else if (ring->format == ZSTD) {
+                        len = fill_zstd(ring, zds, &in, block->data);
+                } else {
+                        len = fill_plain(ring, block->data);
+                }
+                block->len = len;
+
+                pthread_mutex_lock(&ring->lock);
+                if (len != 0) {
+                        ring->produced++;
+                }
+                pthread_cond_signal(&ring->filled);
+                pthread_mutex_unlock(&ring->lock);
+        }
+
+        pthread_mutex_lock(&ring->lock);
+        ring->finished = true;
+        pthread_cond_signal(&ring->filled);
+        pthread_mutex_unlock(&ring->lock);
+
+        if (ring->format == GZIP) {
+                inflateEnd(&zs);
+        }
+        ZSTD_freeDStream(zds);
+        return NULL;
+}
+
+/*************fill_plain**************
+ * Use:
+ *      Copies the next raw input bytes into a block unchanged
+ * Return:
+ *      number of bytes placed in out, 0 once the input is exhausted
+ * Parameters:
+ *      Ring *ring:            ring whose source is read
+ *      char *out:             block to fill, BLOCK_SIZE bytes long
+ * Expects:
+ *      None
+ */
+size_t fill_plain(Ring *ring, char *out)
+{
+        return read_source(ring, (unsigned char *)out, BLOCK_SIZE);
+}
+
+/*************fill_gzip**************
+ * Use:
+ *      Inflates gzip input into a block, moving on to the next member when
+ *      several gzip files have been concatenated. Like gzip -d, bytes after
+ *      the last member that do not start a new member (such as zero
+ *      padding up to a block size) are ignored.
+ * Return:
+ *      number of bytes placed in out, 0 once every member is inflated
+ * Parameters:
+ *      Ring *ring:            ring whose source is read
+ *      z_stream *zs:          inflate state carried between blocks
+ *      char *out:             block to fill, BLOCK_SIZE bytes long
+ * Expects:
+ *      zs was set up with inflateInit2
+ * Notes:
+ *      Will CRE if the input is corrupt or ends partway through a member,
+ *      including any member after the first that starts with the gzip magic
+ */
+size_t fill_gzip(Ring *ring, z_stream *zs, char *out)
+{
+        zs->next_out = (unsigned char *)out;
+        zs->avail_out = BLOCK_SIZE;
+
+        while (zs->avail_out != 0 && !ring->trailing_done) {
+                if (zs->avail_in == 0 && !ring->source_done) {
+                        zs->avail_in = read_source(ring, ring->in,
+                                                   BLOCK_SIZE);
+                        zs->next_in = ring->in;
+                }
+
+                if (ring->member_done) {
+                        /* the magic may be split across two reads */
+                        if (zs->avail_in == 1 && !ring->source_done) {
+                                ring->in[0] = zs->next_in[0];
+                                zs->avail_in = 1 + read_source(ring,
+                                                               ring->in + 1,
+                                                               BLOCK_SIZE - 1);
+                                zs->next_in = ring->in;
+                        }
+
+                        /* anything but the gzip magic here is padding */
+                        if (sniff(zs->next_in, zs->avail_in) != GZIP) {
+                                ring->trailing_done = true;
+                                break;
+                        }
+                        ring->member_done = false;
+                }
+
+                int ret = inflate(zs, Z_NO_FLUSH);
+                if (ret == Z_STREAM_END) {
+                        ring->member_done = true;
+                        inflateReset(zs);
+                        continue;
+                }
+
+                /* Z_BUF_ERROR here means the input stopped mid-member */
+                assert(ret == Z_OK);
+        }
+        return BLOCK_SIZE - zs->avail_out;
+}
+
+/*************fill_zstd**************
+ * Use:
+ *      Decompresses zstd input into a block, running through every frame
+ * Return:
+ *      number of bytes placed in out, 0 once every frame is decompressed
+ * Parameters:
+ *      Ring *ring:            ring whose source is read
+ *      ZSTD_DStream *zds:     decompression state carried between blocks
+ *      ZSTD_inBuffer *in:     unconsumed input carried between blocks
+ *      char *out:             block to fill, BLOCK_SIZE bytes long
+ * Expects:
+ *      in->src points to ring->in
+ * Notes:
+ *      Will CRE if the input is corrupt or ends partway through a frame
+ */
+size_t fill_zstd(Ring *ring, ZSTD_DStream *zds, ZSTD_inBuffer *in, char *out)
+{
+        ZSTD_outBuffer block = { out, BLOCK_SIZE, 0 };
+
+        while (block.pos < block.size) {
+                if (in->pos == in->size && !ring->source_done) {
+                        in->size = read_source(ring, ring->in, BLOCK_SIZE);
+                        in->pos = 0;
+                }
+
+                size_t in_before = in->pos;
+                size_t out_before = block.pos;
+                size_t ret = ZSTD_decompressStream(zds, &block, in);
+                assert(!ZSTD_isError(ret));
+
+                /* a return of 0 means the last frame touched was finished */
+                bool progress = (in->pos != in_before ||
+                                 block.pos != out_before);
+                if (progress) {
+                        ring->frame_open = (ret != 0);
+                }
+
+                /* input is gone and nothing is left buffered inside zstd */
+                if (ring->source_done && in->pos == in->size && !progress) {
+                        assert(!ring->frame_open); /* CRE on truncated frame */
+                        break;
+                }
+        }
+        return block.pos;
+}
+
+/*************ring_read**************
+ * Use:
+ *      stdio read function for the decompressed stream. Copies bytes out of
+ *      the oldest filled block, waiting for the thread if none is ready
+ * Return:
+ *      number of bytes placed in buf, 0 at the end of the input
+ * Parameters:
+ *      void *cookie:          pointer to the Ring being read
+ *      char *buf:             buffer to copy into
+ *      size_t size:           capacity of buf
+ * Expects:
+ *      None
+ */
+ssize_t ring_read(void *cookie, char *buf, size_t size)
+{
+        Ring *ring = cookie;
+
+        pthread_mutex_lock(&ring->lock);
+        while (ring->consumed == ring->produced && !ring->finished) {
+                pthread_cond_wait(&ring->filled, &ring->lock);
+        }
+        bool empty = (ring->consumed == ring->produced);
+        pthread_mutex_unlock(&ring->lock);
+
+        if (empty) {
+                return 0;
+        }
+
+        /* a filled block is not touched by the thread until it is drained */
+        Block *block = &ring->blocks[ring->consumed % RING_BLOCKS];
+        size_t n = block->len - ring->read_pos;
+        if (n > size) {
+                n = size;
+        }
+        memcpy(buf, block->data + ring->read_pos, n);
+        ring->read_pos += n;
+
+        if (ring->read_pos == block->len) {
+                ring->read_pos = 0;
+                pthread_mutex_lock(&ring->lock);
+                ring->consumed++;
+                pthread_cond_signal(&ring->drained);
+                pthread_mutex_unlock(&ring->lock);
+        }
+        return (ssize_t)n;
+}
+
+/*************ring_close**************
+ * Use:
+ *      stdio close function for the decompressed stream. Stops and joins
+ *      the decompressing thread and frees the ring
+ * Return:
+ *      0
+ * Parameters:
+ *      void *cookie:          pointer to the Ring being closed
+ * Expects:
+ *      None
+ */
+int ring_close(void *cookie)
+{
+        Ring *ring = cookie;
+
+        pthread_mutex_lock(&ring->lock);
+        ring->stopping = true;
+        pthread_cond_signal(&ring->drained);
+        pthread_mutex_unlock(&ring->lock);
+
+        pthread_join(ring->thread, NULL);
+
+        pthread_mutex_destroy(&ring->lock);
+        pthread_cond_destroy(&ring->filled);
+        pthread_cond_destroy(&ring->drained);
+        free(ring);
+        return 0;
+}
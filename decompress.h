@@ -0,0 +1,23 @@
+/*
+ *     decompress.h
+ *     by agent, 10/18/2026
+ *     filesofpix
+ *
+ *     Header file for the decompression portion of the program. Includes
+ *     function declarations for functions that detect gzip or zstd
+ *     compressed input and hand back a stream of the decompressed bytes,
+ *     filled by a dedicated thread through a ring of blocks. Includes
+ *     standard libraries.
+ */
+
+#ifndef DECOMPRESS_H
+#define DECOMPRESS_H
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+
+FILE *decompress_open(FILE *source);
+bool is_compressed(FILE *source);
+
+#endif
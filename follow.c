@@ -0,0 +1,382 @@
+/*
+ *     follow.c
+ *     by agent, 10/18/2026
+ *     filesofpix
+ *
+ *     Function implementations for the follow portion of the program.
+ *     Watches a file with inotify while another process appends to it, hands
+ *     back each complete line as soon as it has been written, and blocks at
+ *     the end of the file until more bytes arrive. Following ends when the
+ *     last writer closes the file, when the file is deleted or moved, when
+ *     no bytes arrive for the idle timeout, or on SIGINT/SIGTERM, so that
+ *     the image read so far is still written.
+ *     Lets restoration keep its state across appends instead of rereading
+ *     the file from the start.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "follow.h"
+
+/* room for "/proc/<pid>/fdinfo/<fd>" with two full-length dirent names */
+#define PROC_PATH_SIZE 1024
+
+/* inotify events which mean no more bytes will be appended to the file */
+#define FOLLOW_DONE_MASK (IN_DELETE_SELF | IN_MOVE_SELF)
+
+struct Follow {
+        int notify_fd;         /* inotify instance watching the file */
+        int file_fd;           /* the file, to see when it is unlinked */
+        int idle_timeout;      /* seconds to wait for bytes, 0 for no limit */
+        bool done;             /* true once no more lines will be read */
+        bool writer_seen;      /* true once a writer has written bytes */
+        dev_t dev;             /* identity of the followed file */
+        ino_t ino;
+        sigset_t old_mask;     /* signal mask to restore when done */
+        struct sigaction old_int;
+        struct sigaction old_term;
+};
+
+/* set from the signal handler, so it cannot live inside a Follow */
+static volatile sig_atomic_t stop_requested = 0;
+
+void request_stop(int signum);
+void wait_for_growth(Follow_T follow);
+bool writer_open(Follow_T follow);
+bool fd_writes_file(const char *pid, const char *fd, Follow_T follow);
+
+/*************follow_new**************
+ * Use:
+ *      Starts watching the given file for appended bytes, and takes over
+ *      SIGINT and SIGTERM so they end the follow instead of the program
+ * Return:
+ *      Follow_T holding the watch
+ * Parameters:
+ *      const char *filename:  const char pointer to a c-string of a filename
+ *      int idle_timeout:      seconds without new bytes before following
+ *                             ends, 0 to follow until the last writer
+ *                             closes the file. Writers that reopen the
+ *                             file for every append (such as >>) need a
+ *                             timeout, since without one following ends
+ *                             at the first close. A file that is already
+ *                             complete also needs one, since without a
+ *                             writer ever seen following never ends.
+ * Expects:
+ *      filename to name an existing file
+ * Notes:
+ *      Will CRE if the file cannot be watched
+ *      SIGINT and SIGTERM stay blocked while lines are parsed and are only
+ *      taken while waiting for the file to grow
+ */
+Follow_T follow_new(const char *filename, int idle_timeout)
+{
+        assert(filename != NULL && idle_timeout >= 0);
+
+        Follow_T follow = malloc(sizeof(*follow));
+        assert(follow != NULL);
+
+        follow->notify_fd = inotify_init1(IN_CLOEXEC);
+        assert(follow->notify_fd != -1);
+
+        /*
+         * unlinking changes the link count, which raises IN_ATTRIB, and a
+         * writer closing the file is only a reason to look for other writers
+         */
+        int watch = inotify_add_watch(follow->notify_fd, filename,
+                                      IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE |
+                                      FOLLOW_DONE_MASK);
+        assert(watch != -1);
+
+        follow->file_fd = open(filename, O_RDONLY | O_CLOEXEC);
+        assert(follow->file_fd != -1);
+
+        struct stat st;
+        int statted = fstat(follow->file_fd, &st);
+        assert(statted == 0);
+        follow->dev = st.st_dev;
+        follow->ino = st.st_ino;
+
+        follow->idle_timeout = idle_timeout;
+        follow->done = false;
+        follow->writer_seen = false;
+
+        /* the handler only records the signal; the wait acts on it */
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = request_stop;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, &follow->old_int);
+        sigaction(SIGTERM, &action, &follow->old_term);
+
+        sigset_t stops;
+        sigemptyset(&stops);
+        sigaddset(&stops, SIGINT);
+        sigaddset(&stops, SIGTERM);
+        sigprocmask(SIG_BLOCK, &stops, &follow->old_mask);
+
+        return follow;
+}
+
+/*************request_stop**************
+ * Use:
+ *      Signal handler for SIGINT and SIGTERM while following a file
+ * Return:
+ *      None
+ * Parameters:
+ *      int signum:            number of the signal caught
+ * Expects:
+ *      None
+ */
+void request_stop(int signum)
+{
+        (void)signum;
+        stop_requested = 1;
+}
+
+/*************follow_readaline**************
+ * Use:
+ *      Reads the next complete line from a file that is still being written.
+ *      If the end of the file is reached partway through a line, rewinds to
+ *      the start of that line and waits for the writer to append more.
+ * Return:
+ *      size_t variable representing the length of the line that was read in,
+ *      0 (with *datapp set to NULL) once following has ended and every
+ *      complete line has been read
+ * Parameters:
+ *      FILE *inputfd:         pointer to a seekable input file stream
+ *      char **datapp:         char pointer that points to the address of the
+ *                             first byte of the line we are reading
+ *      Follow_T follow:       watch on the file inputfd reads from
+ * Expects:
+ *      inputfd was opened on the file follow is watching
+ * Notes:
+ *      Will CRE if inputfd cannot be repositioned
+ *      A trailing line with no newline is dropped, just like readaline
+ */
+size_t follow_readaline(FILE *inputfd, char **datapp, Follow_T follow)
+{
+        assert(inputfd != NULL && datapp != NULL && follow != NULL);
+
+        while (true) {
+                long start = ftell(inputfd);
+                assert(start != -1);
+
+                size_t num = readaline(inputfd, datapp);
+                if (*datapp != NULL || follow->done) {
+                        return num;
+                }
+
+                /* back up to the partial line and clear EOF before waiting */
+                int seeked = fseek(inputfd, start, SEEK_SET);
+                assert(seeked == 0);
+                wait_for_growth(follow);
+        }
+}
+
+/*************wait_for_growth**************
+ * Use:
+ *      Blocks until the watched file has been appended to, or marks follow
+ *      as done if the file was deleted or moved, the idle timeout passed,
+ *      SIGINT/SIGTERM arrived, or (only without an idle timeout) a writer
+ *      closed the file and no process still has it open for writing
+ * Return:
+ *      None
+ * Parameters:
+ *      Follow_T follow:       watch on the file being written
+ * Expects:
+ *      follow is not NULL
+ * Notes:
+ *      Will CRE if waiting on or reading from the inotify instance fails
+ */
+void wait_for_growth(Follow_T follow)
+{
+        /*
+         * no writer found yet is no reason to end, the writer may be late, and
+         * an opener that has written nothing (such as touch) is not one yet
+         */
+        struct stat st;
+        if (follow->idle_timeout == 0 && !follow->writer_seen &&
+            fstat(follow->file_fd, &st) == 0 && st.st_size > 0) {
+                follow->writer_seen = writer_open(follow);
+        }
+
+        struct pollfd ready = { follow->notify_fd, POLLIN, 0 };
+        struct timespec timeout = { follow->idle_timeout, 0 };
+
+        /* SIGINT and SIGTERM can only arrive inside ppoll */
+        int polled = ppoll(&ready, 1,
+                           follow->idle_timeout > 0 ? &timeout : NULL,
+                           &follow->old_mask);
+        assert(polled != -1 || errno == EINTR);
+
+        if (stop_requested || polled == 0) {
+                follow->done = true;
+                return;
+        }
+        if (polled == -1) {
+                return; /* some other signal; just look at the file again */
+        }
+
+        char events[4096]
+                __attribute__((aligned(__alignof__(struct inotify_event))));
+
+        ssize_t len = read(follow->notify_fd, events, sizeof(events));
+        assert(len > 0);
+
+        /* walk every queued event, looking for the file going away */
+        bool closed = false;
+        for (char *p = events; p < events + len;
+             p += sizeof(struct inotify_event) +
+                  ((struct inotify_event *)p)->len) {
+
+                uint32_t mask = ((struct inotify_event *)p)->mask;
+                if (mask & FOLLOW_DONE_MASK) {
+                        follow->done = true;
+                }
+                if (mask & IN_MODIFY) {
+                        follow->writer_seen = true;
+                }
+                if (mask & IN_CLOSE_WRITE) {
+                        closed = true;
+                }
+
+                /* IN_DELETE_SELF waits for every fd to close, so check */
+                if ((mask & IN_ATTRIB) && fstat(follow->file_fd, &st) == 0 &&
+                    st.st_nlink == 0) {
+                        follow->done = true;
+                }
+        }
+
+        /* one writer closing ends the capture only if it was the last */
+        if (closed && follow->idle_timeout == 0 && follow->writer_seen &&
+            !follow->done && !writer_open(follow)) {
+                follow->done = true;
+        }
+}
+
+/*************writer_open**************
+ * Use:
+ *      Looks through /proc for any process holding the followed file open
+ *      for writing
+ * Return:
+ *      true if a writer was found, or if /proc cannot be read at all
+ * Parameters:
+ *      Follow_T follow:       watch on the file being written
+ * Expects:
+ *      None
+ * Notes:
+ *      Only processes whose descriptors this user may inspect are seen
+ */
+bool writer_open(Follow_T follow)
+{
+        DIR *proc = opendir("/proc");
+        if (proc == NULL) {
+                return true; /* cannot tell, so keep waiting */
+        }
+
+        bool found = false;
+        struct dirent *pid;
+        while (!found && (pid = readdir(proc)) != NULL) {
+                if (!isdigit((unsigned char)pid->d_name[0])) {
+                        continue;
+                }
+
+                char path[PROC_PATH_SIZE];
+                snprintf(path, sizeof(path), "/proc/%s/fd", pid->d_name);
+                DIR *fds = opendir(path);
+                if (fds == NULL) {
+                        continue; /* gone, or not ours to look at */
+                }
+
+                struct dirent *fd;
+                while (!found && (fd = readdir(fds)) != NULL) {
+                        found = fd_writes_file(pid->d_name, fd->d_name,
+                                               follow);
+                }
+                closedir(fds);
+        }
+        closedir(proc);
+        return found;
+}
+
+/*************fd_writes_file**************
+ * Use:
+ *      Checks whether one open descriptor of one process refers to the
+ *      followed file and was opened for writing
+ * Return:
+ *      true if it does
+ * Parameters:
+ *      const char *pid:       c-string of the process id
+ *      const char *fd:        c-string of the descriptor number
+ *      Follow_T follow:       watch on the file being written
+ * Expects:
+ *      None
+ */
+bool fd_writes_file(const char *pid, const char *fd, Follow_T follow)
+{
+        char path[PROC_PATH_SIZE];
+        struct stat st;
+
+        snprintf(path, sizeof(path), "/proc/%s/fd/%s", pid, fd);
+        if (stat(path, &st) != 0 || st.st_dev != follow->dev ||
+            st.st_ino != follow->ino) {
+                return false;
+        }
+
+        /* fdinfo gives the open flags in octal on a "flags:" line */
+        snprintf(path, sizeof(path), "/proc/%s/fdinfo/%s", pid, fd);
+        FILE *info = fopen(path, "r");
+        if (info == NULL) {
+                return false;
+        }
+
+        char field[64];
+        unsigned int flags = 0;
+        bool writes = false;
+        while (fscanf(info, "%63s", field) == 1) {
+                if (strcmp(field, "flags:") == 0 &&
+                    fscanf(info, "%o", &flags) == 1) {
+                        writes = ((flags & O_ACCMODE) != O_RDONLY);
+                        break;
+                }
+        }
+        fclose(info);
+        return writes;
+}
+
+/*************follow_free**************
+ * Use:
+ *      Stops watching the file, flushes stdout, gives SIGINT and SIGTERM
+ *      back, and frees the memory associated with follow
+ * Return:
+ *      None
+ * Parameters:
+ *      Follow_T *follow:      pointer to the watch to be freed
+ * Expects:
+ *      None
+ * Notes:
+ *      A signal still pending is delivered once unblocked, so the image
+ *      must already be flushed by then
+ */
+void follow_free(Follow_T *follow)
+{
+        if (*follow != NULL) {
+                close((*follow)->notify_fd);
+                close((*follow)->file_fd);
+                fflush(stdout);
+                sigaction(SIGINT, &(*follow)->old_int, NULL);
+                sigaction(SIGTERM, &(*follow)->old_term, NULL);
+                sigprocmask(SIG_SETMASK, &(*follow)->old_mask, NULL);
+                free(*follow);
+                *follow = NULL;
+        }
+}
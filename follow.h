@@ -0,0 +1,28 @@
+/*
+ *     follow.h
+ *     by agent, 10/18/2026
+ *     filesofpix
+ *
+ *     Header file for the follow portion of the program. Includes function
+ *     declarations for functions that watch a file which is still being
+ *     written to, read complete lines from it as they are appended, decide
+ *     when following should end, and free the watch. Includes standard
+ *     libraries.
+ */
+
+#ifndef FOLLOW_H
+#define FOLLOW_H
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <ctype.h>
+#include "readaline.h"
+
+typedef struct Follow *Follow_T;
+
+Follow_T follow_new(const char *filename, int idle_timeout);
+size_t follow_readaline(FILE *inputfd, char **datapp, Follow_T follow);
+void follow_free(Follow_T *follow);
+
+#endif
@@ -0,0 +1,155 @@
+/*
+ *     handoff.c
+ *     by agent, 10/18/2026
+ *     filesofpix
+ *
+ *     Function implementations for the handoff portion of the program.
+ *     Instead of printing the image as text-headed pgm through stdout,
+ *     writes a small binary header and the raw pixels into an anonymous
+ *     memfd, seals it so it can no longer change, and passes the descriptor
+ *     over a Unix socket. The receiving process can mmap the pixels directly
+ *     without copying them through a pipe or parsing a header.
+ */
+
+#define _GNU_SOURCE
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "handoff.h"
+
+int image_memfd(Rows_T rows);
+void send_fd(int fd, const char *socket_path);
+
+/*************handoff_image**************
+ * Use:
+ *      Hands the restored image to the process listening on socket_path
+ * Return:
+ *      None
+ * Parameters:
+ *      Rows_T rows:           set of plain rows of the image
+ *      const char *socket_path:  path of the listening Unix socket
+ * Expects:
+ *      socket_path names a listening SOCK_STREAM Unix socket
+ * Notes:
+ *      Will CRE if the memfd cannot be built or the socket cannot be reached
+ */
+void handoff_image(Rows_T rows, const char *socket_path)
+{
+        int fd = image_memfd(rows);
+        send_fd(fd, socket_path);
+
+        /* the receiver now holds its own reference to the memfd */
+        close(fd);
+}
+
+/*************image_memfd**************
+ * Use:
+ *      Writes the header of the image into a new memfd, decodes the rows
+ *      straight into the memfd after it, and seals it against any further
+ *      change
+ * Return:
+ *      file descriptor of the sealed memfd
+ * Parameters:
+ *      Rows_T rows:           set of plain rows of the image
+ * Expects:
+ *      every row holds the same number of pixels
+ * Notes:
+ *      Will CRE if creating, sizing, mapping or sealing the memfd fails
+ */
+int image_memfd(Rows_T rows)
+{
+        const int width = rows_width(rows);
+        const int height = rows_height(rows);
+        const size_t pixels = (size_t)width * (size_t)height;
+        const size_t size = sizeof(Handoff_header) + pixels;
+
+        int fd = memfd_create("restoration", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        assert(fd != -1);
+
+        int sized = ftruncate(fd, (off_t)size);
+        assert(sized == 0);
+
+        unsigned char *image = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED, fd, 0);
+        assert(image != MAP_FAILED);
+
+        Handoff_header header;
+        memcpy(header.magic, HANDOFF_MAGIC, sizeof(header.magic));
+        header.width = (uint32_t)width;
+        header.height = (uint32_t)height;
+        header.maxval = 255;
+        memcpy(image, &header, sizeof(header));
+
+        /* a new memfd reads as zeros, so short rows stay black */
+        rows_decode(rows, (char *)image + sizeof(header), width);
+
+        /* writable mappings must be gone before F_SEAL_WRITE is allowed */
+        int unmapped = munmap(image, size);
+        assert(unmapped == 0);
+
+        int sealed = fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW |
+                                            F_SEAL_WRITE | F_SEAL_SEAL);
+        assert(sealed == 0);
+        return fd;
+}
+
+/*************send_fd**************
+ * Use:
+ *      Connects to the Unix socket at socket_path and passes fd across it
+ *      as SCM_RIGHTS ancillary data
+ * Return:
+ *      None
+ * Parameters:
+ *      int fd:                file descriptor to pass
+ *      const char *socket_path:  path of the listening Unix socket
+ * Expects:
+ *      socket_path names a listening SOCK_STREAM Unix socket
+ * Notes:
+ *      Will CRE if socket_path is too long, or if connecting or sending
+ *      fails
+ */
+void send_fd(int fd, const char *socket_path)
+{
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        assert(strlen(socket_path) < sizeof(addr.sun_path));
+        strcpy(addr.sun_path, socket_path);
+
+        int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        assert(sock != -1);
+
+        int connected = connect(sock, (struct sockaddr *)&addr, sizeof(addr));
+        assert(connected == 0);
+
+        /* one byte of real data is needed to carry the ancillary data */
+        char byte = 0;
+        struct iovec iov = { .iov_base = &byte, .iov_len = 1 };
+
+        union {
+                char buf[CMSG_SPACE(sizeof(int))];
+                struct cmsghdr align;
+        } control;
+        memset(&control, 0, sizeof(control));
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+        ssize_t sent = sendmsg(sock, &msg, 0);
+        assert(sent == 1);
+        close(sock);
+}
@@ -0,0 +1,36 @@
+/*
+ *     handoff.h
+ *     by agent, 10/18/2026
+ *     filesofpix
+ *
+ *     Header file for the handoff portion of the program. Includes the
+ *     layout of the binary header placed in front of the pixels and function
+ *     declarations for functions that write the restored image into a sealed
+ *     memfd and pass that memfd to another process over a Unix socket.
+ *     Includes standard libraries.
+ */
+
+#ifndef HANDOFF_H
+#define HANDOFF_H
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "rows.h"
+
+#define HANDOFF_MAGIC "FPIX"
+
+/* 
+ * first bytes of the memfd -- width * height raw pixels follow directly,
+ * one byte per pixel, in row-major order
+ */
+typedef struct Handoff_header {
+        char magic[4];         /* HANDOFF_MAGIC, without the '\0' */
+        uint32_t width;
+        uint32_t height;
+        uint32_t maxval;
+} Handoff_header;
+
+void handoff_image(Rows_T rows, const char *socket_path);
+
+#endif
@@ -4,10 +4,8 @@
  *     filesofpix
  *
  *     Function implementations for the memory freeing portion of the program.
- *     Allocates memory for a line with a given size, frees the memory
- *     associated with a given line, frees the memory associated with the
- *     program's Hanson structures, and frees the table contents to be used in
- *     a mapping function.
+ *     Allocates memory for a line with a given size and frees the memory
+ *     associated with a given line.
  */
 
 #include "memory.h"
@@ -39,42 +37,4 @@ void free_line(char *line)
             line = NULL;
             assert(line == NULL);
         }
-}
-
-/*************free_line_apply************
- * Use:
- *      Mapping function for a hanson table which frees the dynamically
- *      allocated memory.
- * Return:
- *      None
- * Parameters:
- *      const void *key:       pointer to a key in a Hanson Table
- *      void **value:          pointer to a value in a Hanson Table
- *      void *closure:         pointer to a closure for a Hanson Table
- * Expects:
- *      None
- */
-void free_line_apply(const void *key, void **value, void *closure)
-{
-        (void)key;
-        (void)closure;
-        free_line(*value);
-}
-
-/*************structures_free**************
- * Use:
- *      Frees the dynamic memory associated with the given table and list
- * Return:
- *      None
- * Parameters:
- *      Table_T *my_table:     pointer to a Hanson Table
- *      List_T *my_list:       pointer to a Hanson List
- * Expects:
- *      --
- */
-void structures_free(Table_T *my_table, List_T *my_list) 
-{
-        Table_map(*my_table, free_line_apply, NULL); 
-        Table_free(my_table);
-        List_free(my_list);
 }
\ No newline at end of file
@@ -0,0 +1,390 @@
+/*
+ *     pending.c
+ *     by agent, 10/18/2026
+ *     filesofpix
+ *
+ *     Function implementations for the pending line portion of the program.
+ *     Keeps every line whose infusion sequence has not repeated yet in a
+ *     Hanson Table keyed by a 64-bit hash of the infusion sequence, so no
+ *     atom is made for a line until its infusion is known to repeat. Once
+ *     the lines held in memory reach the memory budget, the infusion
+ *     sequence and body of each new line are appended to a temporary spill
+ *     file and only the hash and offset stay in memory. Spilled bytes are
+ *     read back only when a hash matches, to confirm the repeat.
+ */
+
+#include <string.h>
+#include "pending.h"
+#include "memory.h"
+
+typedef struct Entry {
+        uint64_t hash;         /* table key */
+        char *infusion;        /* NULL while spilled */
+        char *line;            /* NULL while spilled */
+        int inf_size;          /* size in bytes of the infusion sequence */
+        size_t num;            /* size in bytes of the line */
+        long offset;           /* spilled infusion, then line, start here */
+        struct Entry *next;    /* other infusions with the same hash */
+} Entry;
+
+struct Pending {
+        Table_T table;         /* hash -> chain of Entry */
+        size_t mem_limit;      /* bytes of lines to hold, 0 for no limit */
+        size_t resident;       /* bytes of infusions and lines in memory */
+        FILE *spill;           /* append-only temporary file, or NULL */
+};
+
+uint64_t infusion_hash(const char *infusion, int inf_size);
+int hash_cmp(const void *x, const void *y);
+unsigned hash_hash(const void *key);
+Entry *find_entry(Pending_T pending,
+                  Entry *chain,
+                  const char *infusion,
+                  int inf_size);
+void spill_entry(Pending_T pending, Entry *entry);
+char *load_line(Pending_T pending, Entry *entry);
+void free_entry_apply(const void *key, void **value, void *closure);
+
+/*************pending_new**************
+ * Use:
+ *      Creates an empty set of pending lines
+ * Return:
+ *      Pending_T holding no lines
+ * Parameters:
+ *      size_t mem_limit:      bytes of infusions and line bodies to keep in
+ *                             memory before spilling to disk, 0 to never
+ *                             spill
+ * Expects:
+ *      None
+ * Notes:
+ *      May CRE if malloc fails
+ */
+Pending_T pending_new(size_t mem_limit)
+{
+        Pending_T pending = malloc(sizeof(*pending));
+        assert(pending != NULL);
+
+        pending->table = Table_new(1000, hash_cmp, hash_hash);
+        pending->mem_limit = mem_limit;
+        pending->resident = 0;
+        pending->spill = NULL;
+        return pending;
+}
+
+/*************pending_put**************
+ * Use:
+ *      Stores line under its infusion sequence, taking ownership of line.
+ *      If a line is already stored under the same infusion, that line is
+ *      handed back and the new one is kept in memory in its place.
+ * Return:
+ *      the line previously stored under the infusion (read back from the
+ *      spill file if needed), or NULL if there was none
+ * Parameters:
+ *      Pending_T pending:     set of pending lines
+ *      const char *infusion:  infusion sequence of line, copied if kept
+ *      int inf_size:          size in bytes of the infusion sequence
+ *      char *line:            pointer to the first char of the line
+ *      size_t num:            size in bytes of line
+ * Expects:
+ *      pending, infusion and line are not NULL
+ * Notes:
+ *      May CRE if malloc or the spill file fails
+ */
+char *pending_put(Pending_T pending,
+                  const char *infusion,
+                  int inf_size,
+                  char *line,
+                  size_t num)
+{
+        uint64_t hash = infusion_hash(infusion, inf_size);
+        Entry *chain = Table_get(pending->table, &hash);
+        Entry *entry = find_entry(pending, chain, infusion, inf_size);
+
+        /* a repeat -- both lines are about to be used, so keep both */
+        if (entry != NULL) {
+                char *original = load_line(pending, entry);
+                entry->line = line;
+                entry->num = num;
+                pending->resident += num;
+                return original;
+        }
+
+        entry = malloc(sizeof(*entry));
+        assert(entry != NULL);
+        entry->hash = hash;
+        entry->infusion = malloc_line((size_t)inf_size + 1);
+        memcpy(entry->infusion, infusion, (size_t)inf_size);
+        entry->inf_size = inf_size;
+        entry->line = line;
+        entry->num = num;
+        entry->next = chain;
+        pending->resident += (size_t)inf_size + num;
+
+        /* spill both halves if holding them would pass the budget */
+        if (pending->mem_limit != 0 &&
+            pending->resident > pending->mem_limit) {
+                spill_entry(pending, entry);
+        }
+
+        /* the new entry heads the chain; an existing key stays in place */
+        Table_put(pending->table, &entry->hash, entry);
+        return NULL;
+}
+
+/*************pending_get**************
+ * Use:
+ *      Looks up the line stored under an infusion sequence
+ * Return:
+ *      the stored line, or NULL if there is none. The line still belongs
+ *      to pending.
+ * Parameters:
+ *      Pending_T pending:     set of pending lines
+ *      const char *infusion:  infusion sequence to look up
+ *      int inf_size:          size in bytes of the infusion sequence
+ * Expects:
+ *      the line was stored by the pending_put that found the repeat, so it
+ *      is held in memory
+ */
+char *pending_get(Pending_T pending, const char *infusion, int inf_size)
+{
+        uint64_t hash = infusion_hash(infusion, inf_size);
+        Entry *entry = find_entry(pending, Table_get(pending->table, &hash),
+                                  infusion, inf_size);
+        if (entry == NULL) {
+                return NULL;
+        }
+
+        assert(entry->line != NULL);
+        return entry->line;
+}
+
+/*************infusion_hash**************
+ * Use:
+ *      Hashes an infusion sequence with 64-bit FNV-1a
+ * Return:
+ *      the hash
+ * Parameters:
+ *      const char *infusion:  infusion sequence to hash
+ *      int inf_size:          size in bytes of the infusion sequence
+ * Expects:
+ *      None
+ */
+uint64_t infusion_hash(const char *infusion, int inf_size)
+{
+        uint64_t hash = 14695981039346656037ULL;
+        for (int i = 0; i < inf_size; i++) {
+                hash ^= (unsigned char)infusion[i];
+                hash *= 1099511628211ULL;
+        }
+        return hash;
+}
+
+/*************hash_cmp**************
+ * Use:
+ *      Comparison function for the Hanson Table, whose keys point to
+ *      64-bit hashes
+ * Return:
+ *      0 if the hashes are equal, non-zero otherwise
+ * Parameters:
+ *      const void *x:         pointer to a uint64_t hash
+ *      const void *y:         pointer to a uint64_t hash
+ * Expects:
+ *      None
+ */
+int hash_cmp(const void *x, const void *y)
+{
+        uint64_t a = *(const uint64_t *)x;
+        uint64_t b = *(const uint64_t *)y;
+        return (a > b) - (a < b);
+}
+
+/*************hash_hash**************
+ * Use:
+ *      Hash function for the Hanson Table, folding a 64-bit hash down
+ * Return:
+ *      the bucket hash of the key
+ * Parameters:
+ *      const void *key:       pointer to a uint64_t hash
+ * Expects:
+ *      None
+ */
+unsigned hash_hash(const void *key)
+{
+        uint64_t hash = *(const uint64_t *)key;
+        return (unsigned)(hash ^ (hash >> 32));
+}
+
+/*************find_entry**************
+ * Use:
+ *      Finds the entry in a chain of equal hashes whose infusion sequence
+ *      really matches, reading spilled infusions back to compare them
+ * Return:
+ *      the matching entry, or NULL if no entry matches
+ * Parameters:
+ *      Pending_T pending:     set of pending lines
+ *      Entry *chain:          first entry sharing the hash, or NULL
+ *      const char *infusion:  infusion sequence to match
+ *      int inf_size:          size in bytes of the infusion sequence
+ * Expects:
+ *      None
+ * Notes:
+ *      Will CRE if reading the spill file fails
+ */
+Entry *find_entry(Pending_T pending,
+                  Entry *chain,
+                  const char *infusion,
+                  int inf_size)
+{
+        for (Entry *entry = chain; entry != NULL; entry = entry->next) {
+                if (entry->inf_size != inf_size) {
+                        continue;
+                }
+                if (entry->infusion != NULL) {
+                        if (memcmp(entry->infusion, infusion,
+                                   (size_t)inf_size) == 0) {
+                                return entry;
+                        }
+                        continue;
+                }
+
+                /* spilled -- bring the infusion back just to compare */
+                char *spilled = malloc_line((size_t)inf_size + 1);
+                int seeked = fseek(pending->spill, entry->offset, SEEK_SET);
+                assert(seeked == 0);
+                size_t read = fread(spilled, 1, (size_t)inf_size,
+                                    pending->spill);
+                assert(read == (size_t)inf_size);
+
+                bool same = (memcmp(spilled, infusion, (size_t)inf_size) == 0);
+                free_line(spilled);
+                if (same) {
+                        return entry;
+                }
+        }
+        return NULL;
+}
+
+/*************spill_entry**************
+ * Use:
+ *      Appends the infusion sequence and line of entry to the spill file,
+ *      records where they went, and frees them
+ * Return:
+ *      None
+ * Parameters:
+ *      Pending_T pending:     set of pending lines
+ *      Entry *entry:          entry whose infusion and line are in memory
+ * Expects:
+ *      None
+ * Notes:
+ *      Will CRE if the spill file cannot be created or written
+ */
+void spill_entry(Pending_T pending, Entry *entry)
+{
+        if (pending->spill == NULL) {
+                pending->spill = tmpfile(); /* removed when closed */
+                assert(pending->spill != NULL);
+        }
+
+        /* reads move the position, so always come back to the end */
+        int seeked = fseek(pending->spill, 0, SEEK_END);
+        assert(seeked == 0);
+        entry->offset = ftell(pending->spill);
+        assert(entry->offset != -1);
+
+        size_t written = fwrite(entry->infusion, 1, (size_t)entry->inf_size,
+                                pending->spill);
+        written += fwrite(entry->line, 1, entry->num, pending->spill);
+        assert(written == (size_t)entry->inf_size + entry->num);
+
+        pending->resident -= (size_t)entry->inf_size + entry->num;
+        free_line(entry->infusion);
+        free_line(entry->line);
+        entry->infusion = NULL;
+        entry->line = NULL;
+}
+
+/*************load_line**************
+ * Use:
+ *      Takes the line out of entry, reading it back from the spill file if
+ *      it was spilled
+ * Return:
+ *      pointer to the line, now owned by the caller
+ * Parameters:
+ *      Pending_T pending:     set of pending lines
+ *      Entry *entry:          entry to take the line from
+ * Expects:
+ *      None
+ * Notes:
+ *      Will CRE if malloc or reading the spill file fails
+ */
+char *load_line(Pending_T pending, Entry *entry)
+{
+        if (entry->line != NULL) {
+                pending->resident -= entry->num;
+                return entry->line;
+        }
+
+        char *line = malloc_line(entry->num);
+
+        /* the line sits right after its infusion in the spill file */
+        int seeked = fseek(pending->spill, entry->offset + entry->inf_size,
+                           SEEK_SET);
+        assert(seeked == 0);
+        size_t read = fread(line, 1, entry->num, pending->spill);
+        assert(read == entry->num);
+
+        return line;
+}
+
+/*************free_entry_apply************
+ * Use:
+ *      Mapping function for a hanson table which frees each chain of
+ *      entries and anything they still hold in memory
+ * Return:
+ *      None
+ * Parameters:
+ *      const void *key:       pointer to a key in a Hanson Table
+ *      void **value:          pointer to a value in a Hanson Table
+ *      void *closure:         pointer to a closure for a Hanson Table
+ * Expects:
+ *      None
+ */
+void free_entry_apply(const void *key, void **value, void *closure)
+{
+        (void)key;
+        (void)closure;
+
+        Entry *entry = *value;
+        while (entry != NULL) {
+                Entry *next = entry->next;
+                free_line(entry->infusion);
+                free_line(entry->line);
+                free(entry);
+                entry = next;
+        }
+}
+
+/*************pending_free**************
+ * Use:
+ *      Frees every pending line, the table, and the spill file
+ * Return:
+ *      None
+ * Parameters:
+ *      Pending_T *pending:    pointer to the set of pending lines
+ * Expects:
+ *      None
+ */
+void pending_free(Pending_T *pending)
+{
+        if (*pending == NULL) {
+                return;
+        }
+
+        Table_map((*pending)->table, free_entry_apply, NULL);
+        Table_free(&(*pending)->table);
+        if ((*pending)->spill != NULL) {
+                fclose((*pending)->spill);
+        }
+        free(*pending);
+        *pending = NULL;
+}
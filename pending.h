@@ -0,0 +1,34 @@
+/*
+ *     pending.h
+ *     by agent, 10/18/2026
+ *     filesofpix
+ *
+ *     Header file for the pending line portion of the program. Includes
+ *     function declarations for functions that hold the lines read before
+ *     the infusion sequence is known, keyed by a hash of their infusion
+ *     sequence, and that move infusion sequences and line bodies out to a
+ *     temporary file once a memory budget is spent. Includes standard
+ *     libraries and Hanson structure libraries.
+ */
+
+#ifndef PENDING_H
+#define PENDING_H
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "table.h"
+
+typedef struct Pending *Pending_T;
+
+Pending_T pending_new(size_t mem_limit);
+char *pending_put(Pending_T pending,
+                  const char *infusion,
+                  int inf_size,
+                  char *line,
+                  size_t num);
+char *pending_get(Pending_T pending, const char *infusion, int inf_size);
+void pending_free(Pending_T *pending);
+
+#endif
@@ -6,7 +6,7 @@
  *     Function implementations for the processing program.
  *     Includes functions and helper functions that convert and process various
  *     c-strings todifferent formats, such as getting an infusion sequence from 
- *     a plain line and converting from plain to raw pgm format. 
+ *     a plain line and decoding a plain line into a raw pgm row. 
  */
 
 
@@ -50,46 +50,60 @@ char *plain_to_infusion(char *line, int *size, size_t num)
         return infusion;
 }
 
-/*************plain_to_raw**************
+/*************decode_row**************
  * Use:
- *      with the given c-string, return the raw version of that line.
- *      set width to equal the length of the raw line.
+ *      with the given c-string, write the raw version of that line into
+ *      dest, stopping after width pixels.
  * Return:
- *      char pointer to a raw line
+ *      number of pixels found in the line (at most width)
  * Parameters:
  *      char *line:            plain line to extract the raw line
- *      size_t num:            size necessary to malloc container for the raw
- *                             line
- *      int *width:            holds the length of the raw line (width of the
- *                             pgm file) outside the scope of the function
+ *      char *dest:            holds the raw line outside the scope of the
+ *                             function, or NULL to only count the pixels
+ *      int width:             most pixels dest can hold
  * Expects:
- *      num to be as big as the memory in line
+ *      line ends in a newline character
  * Notes:
- *      May CRE if malloc fails
+ *      May CRE if strtol fails
  */
-char *plain_to_raw(char *line, size_t num, int *width)
+int decode_row(char *line, char *dest, int width)
 {
-        char *new_line = malloc(num);
-        
         char *remaining = line;
         int raw_counter = 0;
 
-        while (*remaining != '\n') {
-                /* skip non-digit chars, returning new_line if at end of line */
+        while (*remaining != '\n' && raw_counter < width) {
+                /* skip non-digit chars, stopping if at end of line */
                 find_digit(&remaining);
                 if (*remaining == '\n') {
-                        return new_line;
+                        return raw_counter;
                 }
 
                 /* get next sequence of digits from the line */
                 int digits = get_digits(&remaining);
             
-                /* store the converted integer as a character in new_line */
-                new_line[raw_counter] = (char)digits;
+                /* store the converted integer as a character in dest */
+                if (dest != NULL) {
+                        dest[raw_counter] = (char)digits;
+                }
                 raw_counter++;
-                *width = raw_counter;
         }
-        return new_line;
+        return raw_counter;
+}
+
+/*************raw_width**************
+ * Use:
+ *      with the given c-string, count the pixels of the raw version of that
+ *      line (the width of the pgm file)
+ * Return:
+ *      number of pixels in the line
+ * Parameters:
+ *      char *line:            plain line to count the pixels of
+ * Expects:
+ *      line ends in a newline character
+ */
+int raw_width(char *line)
+{
+        return decode_row(line, NULL, INT_MAX);
 }
 
 
@@ -5,7 +5,7 @@
  *
  *     Header file for the processing portion of the program. Includes
  *     function declarations for functions that extract the infusion sequence
- *     from a plain line, convert a plain line to a raw line, get the next
+ *     from a plain line, decode a plain line into a raw row, get the next
  *     contiguous digits from a pointer to a c-string, and find the next
  *     digit character from a pointer to a c-string. Includes standard
  *     libraries.
@@ -19,10 +19,12 @@
 #include <stdbool.h>
 #include <assert.h>
 #include <ctype.h>
+#include <limits.h>
 #include "memory.h"
 
 char *plain_to_infusion(char *line, int *size, size_t num);
-char *plain_to_raw(char *line, size_t num, int *width);
+int decode_row(char *line, char *dest, int width);
+int raw_width(char *line);
 int get_digits(char **remaining_p);
 void find_digit(char **remaining_p);
 
@@ -5,8 +5,8 @@
  *
  *     Function implementations for the restoration program.
  *     Handles arguments, reads lines in from the file, stores lines
- *     in a Hanson Table, stores repeated infusion sequence lines into a
- *     Hanson list, and prints out the raw content of the file for image
+ *     in a Hanson Table, collects repeated infusion sequence lines as image
+ *     rows, and prints out the raw content of the file for image
  *     processing.
  */
 
@@ -25,30 +25,187 @@
  *      int *argc:             number of arguments in program call
  *      char *argv[]:          pointer to an array of arguments
  * Expects:
- *      two arguments or less
+ *      optional --follow, --idle-timeout SECONDS, --memfd SOCKET and
+ *      --mem-limit SIZE flags and at most one file name
  *      file that exists
  * Notes:
- *      Will CRE if more than 2 arguments are provided
+ *      Will CRE if the arguments are malformed
+ *      gzip or zstd compressed input is decompressed as it is read, except
+ *      with --follow, where it is a CRE
  */
 int main(int argc, char *argv[])
 {
-        assert(argc <= 2);
+        Options opts;
+        parse_args(argc, argv, &opts);
         
-        if (argc == 2) {
+        if (opts.filename != NULL) {
 
-                FILE *fp = file_open(argv[1]);
+                FILE *fp = file_open(opts.filename);
 
-                restoration(fp);
+                /* watch the file so lines appended later are still read */
+                if (opts.follow) {
+                        /* CRE -- a growing compressed file is not followed */
+                        assert(!is_compressed(fp));
+
+                        Follow_T follow = follow_new(opts.filename,
+                                                     opts.idle_timeout);
+                        restoration(fp, follow, opts.handoff, opts.mem_limit);
+                        follow_free(&follow);
+                } else {
+                        FILE *input = decompress_open(fp);
+                        restoration(input, NULL, opts.handoff, opts.mem_limit);
+                        input_close(input, fp);
+                }
 
                 fclose(fp); /* close file */
             
         } else {
-                restoration(stdin);
+                FILE *input = decompress_open(stdin);
+                restoration(input, NULL, opts.handoff, opts.mem_limit);
+                input_close(input, stdin);
         }
 
         return EXIT_SUCCESS;
 }
 
+/******************input_close***************
+ * Use:
+ *      Closes the stream returned by decompress_open, leaving the file it
+ *      read from open
+ * Return:
+ *      None
+ * Parameters:
+ *      FILE *input:           stream returned by decompress_open
+ *      FILE *source:          stream that was passed to decompress_open
+ * Expects:
+ *      None
+ */
+void input_close(FILE *input, FILE *source)
+{
+        if (input != source) {
+                fclose(input);
+        }
+}
+
+/******************parse_args***************
+ * Use:
+ *      Reads the command line into opts
+ * Return:
+ *      None
+ * Parameters:
+ *      int argc:              number of arguments in program call
+ *      char *argv[]:          pointer to an array of arguments
+ *      Options *opts:         pointer to the settings to fill in
+ * Expects:
+ *      opts is not NULL
+ * Notes:
+ *      Will CRE on an unknown flag, more than one file name, --memfd
+ *      without a socket path, --mem-limit without a valid size,
+ *      --idle-timeout without --follow or a valid number of seconds, or
+ *      --follow without a file name (stdin cannot be watched for appends)
+ */
+void parse_args(int argc, char *argv[], Options *opts)
+{
+        opts->filename = NULL;
+        opts->follow = false;
+        opts->idle_timeout = 0;
+        opts->handoff = NULL;
+        opts->mem_limit = 0;
+
+        for (int i = 1; i < argc; i++) {
+                if (strcmp(argv[i], "--follow") == 0) {
+                        opts->follow = true;
+                } else if (strcmp(argv[i], "--idle-timeout") == 0) {
+                        assert(i + 1 < argc);
+                        opts->idle_timeout = parse_seconds(argv[++i]);
+                } else if (strcmp(argv[i], "--memfd") == 0) {
+                        assert(i + 1 < argc);
+                        opts->handoff = argv[++i];
+                } else if (strcmp(argv[i], "--mem-limit") == 0) {
+                        assert(i + 1 < argc);
+                        opts->mem_limit = parse_size(argv[++i]);
+                } else {
+                        /* CRE on unknown flags or a second file name */
+                        assert(argv[i][0] != '-' || argv[i][1] == '\0');
+                        assert(opts->filename == NULL);
+                        opts->filename = argv[i];
+                }
+        }
+
+        assert(!opts->follow || opts->filename != NULL);
+        assert(opts->follow || opts->idle_timeout == 0);
+}
+
+/******************parse_size***************
+ * Use:
+ *      Converts a size such as 4096, 512K, 64M or 2G into bytes
+ * Return:
+ *      the size in bytes
+ * Parameters:
+ *      const char *arg:       c-string holding the size
+ * Expects:
+ *      arg is not NULL
+ * Notes:
+ *      Will CRE if arg is not a positive number with an optional K, M or G
+ *      suffix, or if the size does not fit in a size_t
+ */
+size_t parse_size(const char *arg)
+{
+        /* CRE unless it starts with a digit -- strtoull would take a '-' */
+        assert(isdigit((unsigned char)arg[0]));
+
+        char *end = NULL;
+        errno = 0;
+        unsigned long long size = strtoull(arg, &end, 10);
+
+        /* CRE if the number does not fit or the size is zero */
+        assert(errno != ERANGE && size > 0 && size <= SIZE_MAX);
+
+        int shifts = 0;
+        switch (toupper((unsigned char)*end)) {
+                case 'G': shifts = 3; end++; break;
+                case 'M': shifts = 2; end++; break;
+                case 'K': shifts = 1; end++; break;
+                default:  break;
+        }
+
+        /* CRE on anything trailing the number and suffix */
+        assert(*end == '\0');
+
+        /* CRE if the suffix pushes the size past what a size_t holds */
+        for (int i = 0; i < shifts; i++) {
+                assert(size <= SIZE_MAX / 1024);
+                size *= 1024;
+        }
+        return (size_t)size;
+}
+
+/******************parse_seconds***************
+ * Use:
+ *      Converts a whole, positive number of seconds
+ * Return:
+ *      the number of seconds
+ * Parameters:
+ *      const char *arg:       c-string holding the seconds
+ * Expects:
+ *      arg is not NULL
+ * Notes:
+ *      Will CRE if arg is not a positive number that fits in an int
+ */
+int parse_seconds(const char *arg)
+{
+        /* CRE unless it starts with a digit (no sign or whitespace) */
+        assert(isdigit((unsigned char)arg[0]));
+
+        char *end = NULL;
+        errno = 0;
+        long seconds = strtol(arg, &end, 10);
+
+        assert(errno != ERANGE && *end == '\0');
+        assert(seconds > 0 && seconds <= INT_MAX);
+        return (int)seconds;
+}
+
 /*************restoration**************
  * Use:
  *      Restores an image to raw pgm format from the given corrupted plain file
@@ -56,37 +213,82 @@ int main(int argc, char *argv[])
  *      None
  * Parameters:
  *      File *fp:              pointer to a file stream to read from
+ *      Follow_T follow:       watch on the file fp reads from, or NULL to
+ *                             stop at the current end of the file
+ *      const char *handoff:   Unix socket to pass the image to as a sealed
+ *                             memfd, or NULL to print it to stdout
+ *      size_t mem_limit:      bytes of pending lines to keep in memory
+ *                             before spilling to disk, 0 to never spill
  * Expects:
  *      Valid file stream fp
  */
-void restoration(FILE *fp)
+void restoration(FILE *fp,
+                 Follow_T follow,
+                 const char *handoff,
+                 size_t mem_limit)
 {
         char *line;
-        int width = 0;
-        Table_T my_table = Table_new(1000, NULL, NULL);
-        List_T my_list = List_list(NULL);
+        Pending_T my_pending = pending_new(mem_limit);
+        Rows_T my_rows = rows_new();
 
-        size_t num = readaline(fp, &line);
+        size_t num = next_line(fp, &line, follow);
         while (line != NULL) {
-                const char *inf_atom = get_atom(line, num);
-                char *original_repeat = Table_put(my_table, inf_atom, line);
+                int inf_size = 0;
+                char *infusion = plain_to_infusion(line, &inf_size, num);
+                char *original_repeat = pending_put(my_pending, infusion,
+                                                    inf_size, line, num);
 
-                /*see if infusion sequence has been found with duplicate atom*/
-                if (add_duplicates(original_repeat, &num, &width, &my_table,
-                                   &my_list, inf_atom)) {
+                /*see if infusion sequence has been found with duplicate*/
+                if (add_duplicates(original_repeat, &my_pending, &my_rows,
+                                   infusion, inf_size)) {
 
-                        num = readaline(fp, &line);
+                        num = next_line(fp, &line, follow);
                         
-                        /* loop through lines, adding originals to list */
-                        add_list(&line, &num, &my_list, inf_atom, fp, &width);
+                        /* loop through lines, adding originals to rows */
+                        add_list(&line, &num, &my_rows, infusion, inf_size,
+                                 fp, follow);
                         
                         free_line(line); 
 
-                        print_image(&my_list, width);
+                        /*
+                         * rows are only decoded now that all are known, which
+                         * with --follow is the end of the capture -- no pixel
+                         * can be written before the header gives the height
+                         */
+                        if (handoff != NULL) {
+                                handoff_image(my_rows, handoff);
+                        } else {
+                                print_image(my_rows);
+                        }
                 }
-                num = readaline(fp, &line);
+                free_line(infusion);
+                num = next_line(fp, &line, follow);
         }
-        structures_free(&my_table, &my_list);
+        pending_free(&my_pending);
+        rows_free(&my_rows);
+}
+
+/*************next_line**************
+ * Use:
+ *      Reads the next line of the corrupted file, waiting for more of the
+ *      file to be written when following it
+ * Return:
+ *      size_t variable representing the length of the line that was read in
+ * Parameters:
+ *      File *fp:              pointer to a file stream to read from
+ *      char **line:           address of char pointer set to the line read,
+ *                             or NULL when there are no more lines
+ *      Follow_T follow:       watch on the file fp reads from, or NULL to
+ *                             stop at the current end of the file
+ * Expects:
+ *      Valid file stream fp
+ */
+size_t next_line(FILE *fp, char **line, Follow_T follow)
+{
+        if (follow != NULL) {
+                return follow_readaline(fp, line, follow);
+        }
+        return readaline(fp, line);
 }
 
 /*************file_open**************
@@ -114,70 +316,69 @@ FILE *file_open(const char *filename)
 }
 
 
-/******************get_atom*****************
+/******************same_infusion*****************
  * Use:
- *      Create atom corresponding to infusion sequence of a line
+ *      Checks whether a line has the given infusion sequence
  * Return:
- *      Atom of infusion sequence
+ *      true if the line's infusion sequence matches infusion
  * Parameters:
- *      char *line:            pointer to first char of line read from file
- *      size_t num:            size in bytes of line     
+ *      char *line:                pointer to first char of line read from
+ *                                 file
+ *      size_t num:                size in bytes of line
+ *      const char *infusion:      infusion sequence of the image rows
+ *      int inf_size:              size in bytes of the infusion sequence
  * Expects:
  *      line must not be null
  */
-const char *get_atom(char *line, size_t num) 
+bool same_infusion(char *line,
+                   size_t num,
+                   const char *infusion,
+                   int inf_size) 
 {
-        int atom_size = 0; 
+        int line_size = 0; 
         
-        /* get infusion (non-digit) sequence from line and create corr. atom */
-        char *infusion = plain_to_infusion(line, &atom_size, num);
-        const char *infusion_atom = Atom_new(infusion, atom_size);
+        /* get infusion (non-digit) sequence from line and compare it */
+        char *line_infusion = plain_to_infusion(line, &line_size, num);
+        bool same = (line_size == inf_size &&
+                     memcmp(line_infusion, infusion, (size_t)inf_size) == 0);
 
-        free_line(infusion);
-        return infusion_atom;
+        free_line(line_infusion);
+        return same;
 }
 
 /******************add_duplicates*****************
  * Use:
  *      If a repeated infusion sequence is found, adds the first two
- *      repeated plain lines from the table into the list
+ *      repeated plain lines from the pending lines to the image rows
  * Return:
  *      boolean representing whether or not a repeat was found
  * Parameters:
  *      char *original repeat:     pointer to the first char of the plain
  *                                 line that was potentially repeated
- *      size_t *num:               size_t pointer that holds the size necessary
- *                                 to malloc container for the raw line
- *      int *width:                int pointer that is set to the width of
- *                                 the raw lengths of the lines
- *      Table_T *my_table:         pointer to the first element of a Hanson
- *                                 Table
- *      List_T *my_list:           pointer to the first element of a Hanson
- *                                 List
- *      const char *infusion atom: const char pointer to an atom containing a
- *                                 c-string infusion sequence.
+ *      Pending_T *my_pending:     pointer to the set of pending lines
+ *      Rows_T *my_rows:           pointer to the set of image rows
+ *      const char *infusion:      infusion sequence of the line just read
+ *      int inf_size:              size in bytes of the infusion sequence
  * Expects:
  *      original_repeat is not null for the duplicate function to work
  */
 bool add_duplicates(char *original_repeat,
-                    size_t *num,
-                    int *width,
-                    Table_T *my_table,
-                    List_T *my_list,
-                    const char *infusion_atom)
+                    Pending_T *my_pending,
+                    Rows_T *my_rows,
+                    const char *infusion,
+                    int inf_size)
 {
-        /* check if insertion into table produced a value of duplicate key */
+        /* check if insertion produced a value of duplicate key */
         if (original_repeat != NULL) {
 
-                /* add original raw duplicate to front of the list */
-                char *original_raw = plain_to_raw(original_repeat, *num, width);
-                *my_list = List_push(*my_list, original_raw);
+                /* add original plain duplicate as the first row */
+                rows_add(*my_rows, original_repeat);
                 free_line(original_repeat);
 
-                /* add second raw to front of the list */
-                char *second_repeat = Table_get(*my_table, infusion_atom);
-                char *second_raw = plain_to_raw(second_repeat, *num, width);
-                *my_list = List_push(*my_list, second_raw);
+                /* add second plain duplicate as the next row */
+                char *second_repeat = pending_get(*my_pending, infusion,
+                                                  inf_size);
+                rows_add(*my_rows, second_repeat);
 
                 return true;
         }
@@ -186,85 +387,73 @@ bool add_duplicates(char *original_repeat,
 
 /******************add_list*****************
  * Use:
- *      Finds every original corrupted line and adds the raw, filtered version
- *      to the list or original lines 
+ *      Finds every original corrupted line and adds the plain version to
+ *      the image rows, leaving decoding until every row is known
  * Return:
  *      None
  * Parameters:
  *      char **line:                address of char pointer to line being read
  *                                  from file
- *      size_t *num:                size_t pointer that holds the size necessary
- *                                  to malloc container for the raw line and 
- *                                  atom
- *      List_T *my_list:            pointer to the first element of a Hanson
- *                                  List
- *      const char *infusion atom:  const char pointer to an atom containing a
- *                                  c-string infusion sequence
+ *      size_t *num:                size_t pointer that holds the size in
+ *                                  bytes of the line
+ *      Rows_T *my_rows:            pointer to the set of image rows
+ *      const char *infusion:       infusion sequence of the image rows
+ *      int inf_size:               size in bytes of the infusion sequence
  *      File *fp:                   pointer to a file stream to read from
- *      int *width:                 int pointer that is set to the width of the
- *                                  raw lengths of the lines
+ *      Follow_T follow:            watch on the file fp reads from, or NULL
+ *                                  to stop at the current end of the file
  * Expects:
  *      line must not be null, fp must be a valid file stream
  */
 void add_list(char **line,
               size_t *num,
-              List_T *my_list,
-              const char *infusion_atom,
+              Rows_T *my_rows,
+              const char *infusion,
+              int inf_size,
               FILE *fp,
-              int *width) 
+              Follow_T follow) 
 {
-        /* loop through rest of the file, adding to list if original*/
+        /* loop through rest of the file, adding to rows if original*/
         while (*line != NULL) {
 
-                    const char *new_infusion_atom = get_atom(*line, *num);
-
                     /* check if line is original through same infusino seq */
-                    if (new_infusion_atom == infusion_atom) {
-                            /* add raw original line to list */
-                            char *repeat_raw = plain_to_raw(*line, *num, width);
-                            *my_list = List_push(*my_list, repeat_raw);
+                    if (same_infusion(*line, *num, infusion, inf_size)) {
+                            /* add plain original line to rows */
+                            rows_add(*my_rows, *line);
                     }
 
             free_line(*line);
-            *num = readaline(fp, line);
+            *num = next_line(fp, line, follow);
         }
 }
 
 /*************print_image**************
  * Use:
- *      prints the contents of the list and image info such that
+ *      decodes the rows and prints them with the image info such that
  *      we can process it into an actual image
  * Return:
  *      None
  * Parameters:
- *      List_T *my_list:       pointer to the first element of a Hanson List
- *      int width:             int that stores the width of the image
+ *      Rows_T rows:           set of plain rows of the image
  * Expects:
  *      None
+ * Notes:
+ *      May CRE if malloc fails
  */
-void print_image(List_T *my_list, int width) 
+void print_image(Rows_T rows) 
 {
-        const int height = List_length(*my_list);
+        const int width = rows_width(rows);
+        const int height = rows_height(rows);
         const int MAXVAL = 255;
 
-        /* print header of raw file */
-        printf("P5\n%d %d\n%d\n", width, height, MAXVAL);
-
-        /* reverse list so that first original line is at front of list */
-        *my_list = List_reverse(*my_list);
+        /* decode every row straight into its place in the image */
+        char *pixels = calloc((size_t)width * height, 1);
+        assert(pixels != NULL || (size_t)width * height == 0);
+        rows_decode(rows, pixels, width);
 
-        /* var to hold value popped from front of list - line to be read */
-        char *popped_line = NULL;
-
-        /* pop lines off of list until it is empty */
-        while (List_length(*my_list) != 0) {
-                    
-                *my_list = List_pop(*my_list, (void**)&popped_line);
+        /* print header of raw file, then every pixel */
+        printf("P5\n%d %d\n%d\n", width, height, MAXVAL);
+        fwrite(pixels, 1, (size_t)width * height, stdout);
 
-                /* print every character from the line */
-                for (int i = 0; i < width; i++) {
-                    printf("%c", popped_line[i]);
-                }
-                free_line(popped_line);
-        }
+        free(pixels);
 }
\ No newline at end of file
@@ -5,8 +5,8 @@
  *
  *     Header file for the restoration program. Includes function declarations
  *     for file processing, raw restoration, and helper functions regarding
- *     Hanson Lists and Tables. Includes standard libraries, Hanson structure 
- *     libraries, and other header files necessary for the program to run.
+ *     pending lines and image rows. Includes standard libraries and other
+ *     header files necessary for the program to run.
  */
 
 #ifndef RESTORATION_H
@@ -16,28 +16,54 @@
 #include <stdbool.h>
 #include <assert.h>
 #include <ctype.h>
-#include "atom.h"
-#include "table.h"
-#include "list.h"
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
 #include "readaline.h"
 #include "processing.h"
 #include "memory.h"
+#include "follow.h"
+#include "handoff.h"
+#include "decompress.h"
+#include "rows.h"
+#include "pending.h"
 
-void restoration(FILE *fp);
+/* settings given to the program on the command line */
+typedef struct Options {
+        const char *filename;  /* NULL when reading from stdin */
+        bool follow;           /* keep reading as the file grows */
+        int idle_timeout;      /* seconds to follow without new bytes */
+        const char *handoff;   /* socket to pass a memfd to, or NULL */
+        size_t mem_limit;      /* bytes of pending lines to hold, 0 for all */
+} Options;
+
+void parse_args(int argc, char *argv[], Options *opts);
+void input_close(FILE *input, FILE *source);
+void restoration(FILE *fp,
+                 Follow_T follow,
+                 const char *handoff,
+                 size_t mem_limit);
+size_t parse_size(const char *arg);
+int parse_seconds(const char *arg);
+size_t next_line(FILE *fp, char **line, Follow_T follow);
 FILE *file_open(const char *filename);
-void print_image(List_T *my_list, int width);
-const char *get_atom(char *line, size_t num);
+void print_image(Rows_T rows);
+bool same_infusion(char *line,
+                   size_t num,
+                   const char *infusion,
+                   int inf_size);
 bool add_duplicates(char *original_repeat,
-                    size_t *num,
-                    int *width,
-                    Table_T *my_table,
-                    List_T *my_list,
-                    const char *infusion_atom);
+                    Pending_T *my_pending,
+                    Rows_T *my_rows,
+                    const char *infusion,
+                    int inf_size);
 void add_list(char **line,
               size_t *num,
-              List_T *my_list,
-              const char *infusion_atom,
+              Rows_T *my_rows,
+              const char *infusion,
+              int inf_size,
               FILE *fp,
-              int *width);
+              Follow_T follow);
 
 #endif
\ No newline at end of file
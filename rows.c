@@ -0,0 +1,278 @@
+/*
+ *     rows.c
+ *     by agent, 10/18/2026
+ *     filesofpix
+ *
+ *     Function implementations for the rows portion of the program.
+ *     While the file is read, each original plain line is only copied into
+ *     a growing slab and its offset recorded, keeping the digit conversion
+ *     off the read loop. Once every row is known, the slab is split into
+ *     slices of about equal bytes that are decoded on separate threads, each
+ *     writing directly to its final place in the pixel buffer.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "rows.h"
+#include "processing.h"
+#include "memory.h"
+
+/* less plain text than this per thread costs more to start than it saves */
+#define MIN_SLICE_BYTES (256 * 1024)
+#define MAX_THREADS 64
+
+struct Rows {
+        char *slab;            /* plain lines, back to back */
+        size_t slab_len;
+        size_t slab_cap;
+        size_t *starts;        /* offset of each line in slab */
+        int height;
+        int starts_cap;
+};
+
+typedef struct Slice {
+        Rows_T rows;
+        char *pixels;
+        int width;
+        int first;             /* first row to decode */
+        int last;              /* one past the last row to decode */
+} Slice;
+
+int row_at(Rows_T rows, size_t offset);
+void *decode_slice(void *closure);
+
+/*************rows_new**************
+ * Use:
+ *      Creates an empty set of rows
+ * Return:
+ *      Rows_T holding no rows
+ * Parameters:
+ *      None
+ * Expects:
+ *      None
+ * Notes:
+ *      May CRE if malloc fails
+ */
+Rows_T rows_new(void)
+{
+        Rows_T rows = malloc(sizeof(*rows));
+        assert(rows != NULL);
+
+        rows->slab_cap = 64 * 1024;
+        rows->slab = malloc_line(rows->slab_cap);
+        rows->slab_len = 0;
+
+        rows->starts_cap = 256;
+        rows->starts = malloc(rows->starts_cap * sizeof(size_t));
+        assert(rows->starts != NULL);
+        rows->height = 0;
+        return rows;
+}
+
+/*************rows_add**************
+ * Use:
+ *      Copies a plain line, up to and including its newline character, onto
+ *      the end of the slab as the next row
+ * Return:
+ *      None
+ * Parameters:
+ *      Rows_T rows:           set of rows to add to
+ *      const char *line:      plain line ending in a newline character
+ * Expects:
+ *      line ends in a newline character, as readaline guarantees
+ * Notes:
+ *      May CRE if realloc fails
+ */
+void rows_add(Rows_T rows, const char *line)
+{
+        size_t num = 0;
+        while (line[num] != '\n') {
+                num++;
+        }
+        num++; /* keep the newline so decode_row knows where to stop */
+
+        /* double the slab and offsets as needed, like readaline does */
+        while (rows->slab_len + num > rows->slab_cap) {
+                rows->slab_cap *= 2;
+                rows->slab = realloc(rows->slab, rows->slab_cap);
+                assert(rows->slab != NULL);
+        }
+        if (rows->height == rows->starts_cap) {
+                rows->starts_cap *= 2;
+                rows->starts = realloc(rows->starts,
+                                       rows->starts_cap * sizeof(size_t));
+                assert(rows->starts != NULL);
+        }
+
+        memcpy(rows->slab + rows->slab_len, line, num);
+        rows->starts[rows->height] = rows->slab_len;
+        rows->slab_len += num;
+        rows->height++;
+}
+
+/*************rows_height**************
+ * Use:
+ *      Gets the number of rows collected so far
+ * Return:
+ *      the height of the image
+ * Parameters:
+ *      Rows_T rows:           set of rows
+ * Expects:
+ *      None
+ */
+int rows_height(Rows_T rows)
+{
+        return rows->height;
+}
+
+/*************rows_width**************
+ * Use:
+ *      Gets the width of the image from the last row holding any pixels
+ * Return:
+ *      the number of pixels in that row, 0 if no row holds any
+ * Parameters:
+ *      Rows_T rows:           set of rows
+ * Expects:
+ *      every row holds the same number of pixels
+ */
+int rows_width(Rows_T rows)
+{
+        for (int row = rows->height - 1; row >= 0; row--) {
+                int width = raw_width(rows->slab + rows->starts[row]);
+                if (width != 0) {
+                        return width;
+                }
+        }
+        return 0;
+}
+
+/*************rows_decode**************
+ * Use:
+ *      Decodes every row into its place in pixels, splitting the slab into
+ *      slices of about equal bytes among up to as many threads as there are
+ *      online cores, so a few very wide rows still spread across cores
+ * Return:
+ *      None
+ * Parameters:
+ *      Rows_T rows:           set of rows
+ *      char *pixels:          buffer of width * height chars to fill
+ *      int width:             int that stores the width of the image
+ * Expects:
+ *      pixels is zeroed, so short rows are padded with black
+ * Notes:
+ *      Will CRE if a thread cannot be started
+ */
+void rows_decode(Rows_T rows, char *pixels, int width)
+{
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        size_t by_bytes = rows->slab_len / MIN_SLICE_BYTES;
+        int threads = by_bytes > MAX_THREADS ? MAX_THREADS : (int)by_bytes;
+        if (threads > cores) {
+                threads = (int)cores;
+        }
+        if (threads > rows->height) {
+                threads = rows->height; /* a row is never split */
+        }
+        if (threads < 1) {
+                threads = 1;
+        }
+
+        Slice slices[MAX_THREADS];
+        pthread_t ids[MAX_THREADS];
+
+        for (int i = 0; i < threads; i++) {
+                slices[i].rows = rows;
+                slices[i].pixels = pixels;
+                slices[i].width = width;
+                slices[i].first = row_at(rows, rows->slab_len / threads * i);
+        }
+        for (int i = 0; i < threads; i++) {
+                slices[i].last = (i + 1 < threads) ? slices[i + 1].first
+                                                   : rows->height;
+        }
+
+        /* the calling thread decodes the first slice itself */
+        for (int i = 1; i < threads; i++) {
+                int started = pthread_create(&ids[i], NULL, decode_slice,
+                                             &slices[i]);
+                assert(started == 0);
+        }
+        decode_slice(&slices[0]);
+        for (int i = 1; i < threads; i++) {
+                pthread_join(ids[i], NULL);
+        }
+}
+
+/*************row_at**************
+ * Use:
+ *      Finds the first row starting at or after a byte offset in the slab
+ * Return:
+ *      index of that row, or the height if no row starts that late
+ * Parameters:
+ *      Rows_T rows:           set of rows
+ *      size_t offset:         byte offset into the slab
+ * Expects:
+ *      None
+ */
+int row_at(Rows_T rows, size_t offset)
+{
+        int low = 0;
+        int high = rows->height;
+
+        /* rows start in increasing order, so binary search the starts */
+        while (low < high) {
+                int mid = low + (high - low) / 2;
+                if (rows->starts[mid] < offset) {
+                        low = mid + 1;
+                } else {
+                        high = mid;
+                }
+        }
+        return low;
+}
+
+/*************decode_slice**************
+ * Use:
+ *      Thread body that decodes a contiguous run of rows into the pixels
+ * Return:
+ *      NULL
+ * Parameters:
+ *      void *closure:         pointer to the Slice to decode
+ * Expects:
+ *      slices given to different threads do not overlap
+ */
+void *decode_slice(void *closure)
+{
+        Slice *slice = closure;
+        Rows_T rows = slice->rows;
+
+        for (int row = slice->first; row < slice->last; row++) {
+                decode_row(rows->slab + rows->starts[row],
+                           slice->pixels + (size_t)row * slice->width,
+                           slice->width);
+        }
+        return NULL;
+}
+
+/*************rows_free**************
+ * Use:
+ *      Frees the memory associated with the set of rows
+ * Return:
+ *      None
+ * Parameters:
+ *      Rows_T *rows:          pointer to the set of rows
+ * Expects:
+ *      None
+ */
+void rows_free(Rows_T *rows)
+{
+        if (*rows != NULL) {
+                free_line((*rows)->slab);
+                free((*rows)->starts);
+                free(*rows);
+                *rows = NULL;
+        }
+}
@@ -0,0 +1,29 @@
+/*
+ *     rows.h
+ *     by agent, 10/18/2026
+ *     filesofpix
+ *
+ *     Header file for the rows portion of the program. Includes function
+ *     declarations for functions that collect the original plain lines of
+ *     the image in a single slab, and decode every one of them in parallel
+ *     straight into its row of a pixel buffer once all rows are known.
+ *     Includes standard libraries.
+ */
+
+#ifndef ROWS_H
+#define ROWS_H
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+
+typedef struct Rows *Rows_T;
+
+Rows_T rows_new(void);
+void rows_add(Rows_T rows, const char *line);
+int rows_height(Rows_T rows);
+int rows_width(Rows_T rows);
+void rows_decode(Rows_T rows, char *pixels, int width);
+void rows_free(Rows_T *rows);
+
+#endif